@@ -0,0 +1,43 @@
+#include <random>
+#include <vector>
+#include <iostream>
+#include <iomanip>
+#include "../include/SPPAR/Quadtree.hpp"
+#include "../include/SPPAR/CompactQuadtree.hpp"
+
+struct Entity{
+    Entity(SPPAR::Rectf b)
+    : bounds(b){}
+    const SPPAR::Rectf getPosition() const{
+        return bounds;
+    }
+    SPPAR::Rectf bounds;
+};
+int main(){
+    static std::mt19937 engine(std::random_device{}());
+    std::uniform_real_distribution<> dice(0,10000);
+    SPPAR::Rectf worldBounds(0,0,10000,10000);
+    std::cout << "sizeof(Quadtree) per node: " << sizeof(SPPAR::Quadtree<Entity>) << " bytes" << std::endl;
+    std::cout << std::setw(10) << "entities" << std::setw(10) << "nodes"
+              << std::setw(16) << "Quadtree" << std::setw(16) << "CompactQuadtree"
+              << std::setw(8) << "ratio" << std::endl;
+    for(auto count:{1000u, 10000u, 100000u, 1000000u}){
+        std::vector<Entity> entities;
+        entities.reserve(count);
+        SPPAR::Quadtree<Entity> qtree(worldBounds);
+        SPPAR::CompactQuadtree<Entity> compact(worldBounds);
+        qtree.setMaxCapacity(4).setMaxLevel(12);
+        compact.setMaxCapacity(4).setMaxLevel(12);
+        for(auto i=0u;i<count;++i){
+            entities.emplace_back(SPPAR::Rectf(dice(engine),dice(engine),2,2));
+            qtree.insert(&entities.back());
+            compact.insert(&entities.back());
+        }
+        auto qtreeBytes = qtree.getMemoryUsage();
+        auto compactBytes = compact.getMemoryUsage();
+        std::cout << std::setw(10) << count << std::setw(10) << compact.getNodeCount()
+                  << std::setw(16) << qtreeBytes << std::setw(16) << compactBytes
+                  << std::setw(8) << std::setprecision(3) << (static_cast<double>(qtreeBytes) / compactBytes) << std::endl;
+    }
+    return 0;
+}
@@ -1,7 +1,9 @@
 #ifndef SPPAR_HPP
 #define SPPAR_HPP
 
+#include "SPPAR/Vector2.hpp"
 #include "SPPAR/Rect.hpp"
 #include "SPPAR/Quadtree.hpp"
+#include "SPPAR/CompactQuadtree.hpp"
 
 #endif // SPPAR_HPP
\ No newline at end of file
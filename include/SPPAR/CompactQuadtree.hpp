@@ -0,0 +1,423 @@
+////////////////////////////////////////////////////////////
+// Copyright 2014-2016 Cristian Glez <Cristian.glez.m@gmail.com>
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//  http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+////////////////////////////////////////////////////////////
+
+#ifndef SPPAR_COMPACT_QUADTREE_HPP
+#define SPPAR_COMPACT_QUADTREE_HPP
+
+#include <vector>
+#include <algorithm>
+#include <memory>
+#include <cstdint>
+#include <type_traits>
+
+#include "Rect.hpp"
+
+namespace SPPAR{
+    /**
+     * @class CompactQuadtree
+     * @brief Quadtree with the same partitioning as Quadtree but a small node layout,
+     * the settings are stored once per tree, the bounds of the nodes are computed while
+     * walking down from the root, the four children are consecutive in a single vector
+     * so a node only keeps the index of the first one and small entity lists are kept inline.
+     * 
+     * @tparam T class that will be used, it will be saved as a pointer
+     * @tparam Allocator allocator of T*, it is also rebound for the nodes.
+     * @tparam InlineCapacity number of entities a node keeps without an extra allocation.
+     * @author Cristian Glez <Cristian.glez.m@gmail.com>
+     * @version 0.1
+     */
+    template<class T, class Allocator = std::allocator<T*>, std::size_t InlineCapacity = 2>
+    class CompactQuadtree{
+            static_assert(std::is_member_function_pointer<decltype(&T::getPosition)>::value, "T need to have function 'const Rectf& getPosition() const'");
+            static_assert(InlineCapacity > 0, "InlineCapacity needs to be at least 1");
+        public:
+            /**
+             * @brief Container that uses the quadtree.
+             * we use a std::vector<T*> with the allocator of the quadtree.
+             */
+            using Container = typename std::vector<T*, Allocator>;
+            /**
+             * @brief Constructor
+             * @param bounds Rect bounds of the quadtree.
+             * @param alloc Allocator used for the nodes and its containers.
+             */
+            CompactQuadtree(const Rectf& bounds, const Allocator& alloc = Allocator());
+            /**
+             * @brief adds a pointer from the entity and adds it to its appropriate node, 
+             * if it cannot fit within a node, it will be inserted at the parent.
+             * @param e T*
+             */
+            void insert(T* e);
+            /**
+             * @brief Clears the quadtree and its nodes, the memory is kept to be reused.
+             */
+            void clear() noexcept;
+            /**
+             * @brief Adds the entities(T) from the same space of the specified entity to the Container(the specified entity is also added)
+             *
+             * @param e T* Entity to check.
+             * @param eList Container& to add the entities from the same space of the one provided.
+             */
+            void retrieve(T* e, Container& eList) const;
+            /**
+             * @brief Overload for retrieve without the Container.
+             * @param e T*
+             * @return Container
+             */
+            Container retrieve(T* e) const;
+            /**
+             * @brief sets the new bounds, the bounds of the nodes are derived from it.
+             * @param bounds
+             * @return CompactQuadtree&
+             */
+            CompactQuadtree& setBounds(const Rectf& bounds) noexcept;
+            /**
+             * @brief getter for bounds
+             * @return Rectf
+             */
+            Rectf getBounds() const noexcept;
+            /**
+             * @brief sets the new max capacity.
+             * @param maxCap
+             * @return CompactQuadtree&
+             */
+            CompactQuadtree& setMaxCapacity(std::size_t maxCap) noexcept;
+            /**
+             * @brief getter for maxCapacity
+             * @return std::size_t
+             */
+            const std::size_t& getMaxCapacity() const noexcept;
+            /**
+             * @brief sets the new max Level
+             * @param maxLvl
+             * @return CompactQuadtree&
+             */
+            CompactQuadtree& setMaxLevel(std::size_t maxLvl) noexcept;
+            /**
+             * @brief getter for maxLevel
+             * @return std::size_t
+             */
+            const std::size_t& getMaxLevel() const noexcept;
+            /**
+             * @brief checks if it has been splited
+             * @return bool
+             */
+            bool isSplit() const noexcept;
+            /**
+             * @brief getter for the number of nodes, root included.
+             * @return std::size_t
+             */
+            std::size_t getNodeCount() const noexcept;
+            /**
+             * @brief bytes used by the quadtree, nodes and containers included.
+             * @return std::size_t
+             */
+            std::size_t getMemoryUsage() const noexcept;
+            /**
+             * @brief getter for the allocator
+             * @return Allocator
+             */
+            Allocator getAllocator() const noexcept;
+            ~CompactQuadtree() = default;
+        private:
+            template<class U>
+            using Rebind = typename std::allocator_traits<Allocator>::template rebind_alloc<U>;
+            /**
+             * @brief node of the quadtree, if size is bigger than InlineCapacity
+             * the entities are in overflows[overflow].
+             */
+            struct Node{
+                std::uint32_t firstChild;
+                std::uint32_t size;
+                union{
+                    T* inlined[InlineCapacity];
+                    std::uint32_t overflow;
+                };
+            };
+            /**
+             * @brief bounds of a child, it matches Quadtree::split.
+             * @param bounds Rectf bounds of the parent.
+             * @param index std::size_t index of the child.
+             * @return Rectf
+             */
+            static Rectf getChildBounds(const Rectf& bounds, std::size_t index) noexcept;
+            /**
+             * @brief getter for the index of the child where T is in.
+             * @param bounds Rectf bounds of the node.
+             * @param e
+             * @return int -1 if it doesn't fit in any child.
+             */
+            static int getIndex(const Rectf& bounds, const T& e) noexcept;
+            /**
+             * @brief inserts e in the node or its children.
+             * @param index std::uint32_t index of the node.
+             * @param bounds Rectf bounds of the node.
+             * @param level std::size_t level of the node.
+             * @param e T*
+             */
+            void insert(std::uint32_t index, Rectf bounds, std::size_t level, T* e);
+            /**
+             * @brief private method to subdivide a node.
+             * @param index std::uint32_t
+             */
+            void split(std::uint32_t index);
+            /**
+             * @brief getter for the entity i of a node.
+             * @param index std::uint32_t
+             * @param i std::uint32_t
+             * @return T*
+             */
+            T* getEntity(std::uint32_t index, std::uint32_t i) const noexcept;
+            /**
+             * @brief adds an entity to a node, moving the list to an overflow container if needed.
+             * @param index std::uint32_t
+             * @param e T*
+             */
+            void pushEntity(std::uint32_t index, T* e);
+            /**
+             * @brief removes the entity i of a node, the last entity takes its place.
+             * @param index std::uint32_t
+             * @param i std::uint32_t
+             */
+            void removeEntity(std::uint32_t index, std::uint32_t i) noexcept;
+        private:
+            std::size_t maxCapacity;
+            std::size_t maxLevel;
+            Rectf bounds;
+            std::vector<Node, Rebind<Node>> nodes;
+            std::vector<Container, Rebind<Container>> overflows;
+            std::vector<std::uint32_t, Rebind<std::uint32_t>> freeOverflows;
+    };
+//////////////////////////////////////////////////
+//////// CompactQuadtree Impl
+//////////////////////////////////////////////////
+    template<class T, class Allocator, std::size_t InlineCapacity>
+    CompactQuadtree<T,Allocator,InlineCapacity>::CompactQuadtree(const Rectf& bounds, const Allocator& alloc)
+    : maxCapacity(15)
+    , maxLevel(100)
+    , bounds(bounds)
+    , nodes(1, Node(), alloc)
+    , overflows(alloc)
+    , freeOverflows(alloc){}
+    template<class T, class Allocator, std::size_t InlineCapacity>
+    void CompactQuadtree<T,Allocator,InlineCapacity>::insert(T* e){
+        insert(0, bounds, 0, e);
+    }
+    template<class T, class Allocator, std::size_t InlineCapacity>
+    void CompactQuadtree<T,Allocator,InlineCapacity>::insert(std::uint32_t index, Rectf bounds, std::size_t level, T* e){
+        while(nodes[index].firstChild != 0){
+            int child = getIndex(bounds, *e);
+            if(child == -1){
+                break;
+            }
+            index = nodes[index].firstChild + child;
+            bounds = getChildBounds(bounds, child);
+            ++level;
+        }
+        pushEntity(index, e);
+        if(nodes[index].size > maxCapacity && level < maxLevel){
+            if(nodes[index].firstChild == 0){
+                split(index);
+            }
+            std::uint32_t i = 0;
+            while(i < nodes[index].size){
+                auto entity = getEntity(index, i);
+                int child = getIndex(bounds, *entity);
+                if(child != -1){
+                    removeEntity(index, i);
+                    insert(nodes[index].firstChild + child, getChildBounds(bounds, child), level + 1, entity);
+                }else{
+                    ++i;
+                }
+            }
+        }
+    }
+    template<class T, class Allocator, std::size_t InlineCapacity>
+    void CompactQuadtree<T,Allocator,InlineCapacity>::split(std::uint32_t index){
+        auto firstChild = static_cast<std::uint32_t>(nodes.size());
+        nodes.resize(nodes.size() + 4, Node());
+        nodes[index].firstChild = firstChild;
+    }
+    template<class T, class Allocator, std::size_t InlineCapacity>
+    T* CompactQuadtree<T,Allocator,InlineCapacity>::getEntity(std::uint32_t index, std::uint32_t i) const noexcept{
+        const auto& node = nodes[index];
+        if(node.size <= InlineCapacity){
+            return node.inlined[i];
+        }
+        return overflows[node.overflow][i];
+    }
+    template<class T, class Allocator, std::size_t InlineCapacity>
+    void CompactQuadtree<T,Allocator,InlineCapacity>::pushEntity(std::uint32_t index, T* e){
+        auto& node = nodes[index];
+        if(node.size < InlineCapacity){
+            node.inlined[node.size++] = e;
+            return;
+        }
+        if(node.size == InlineCapacity){
+            std::uint32_t overflow;
+            if(freeOverflows.empty()){
+                overflow = static_cast<std::uint32_t>(overflows.size());
+                overflows.push_back(Container(getAllocator()));
+            }else{
+                overflow = freeOverflows.back();
+                freeOverflows.pop_back();
+            }
+            auto& container = overflows[overflow];
+            container.assign(std::begin(node.inlined), std::end(node.inlined));
+            node.overflow = overflow;
+        }
+        overflows[node.overflow].emplace_back(e);
+        ++node.size;
+    }
+    template<class T, class Allocator, std::size_t InlineCapacity>
+    void CompactQuadtree<T,Allocator,InlineCapacity>::removeEntity(std::uint32_t index, std::uint32_t i) noexcept{
+        auto& node = nodes[index];
+        if(node.size <= InlineCapacity){
+            node.inlined[i] = node.inlined[node.size - 1];
+            --node.size;
+            return;
+        }
+        auto overflow = node.overflow;
+        auto& container = overflows[overflow];
+        container[i] = container.back();
+        container.pop_back();
+        --node.size;
+        if(node.size == InlineCapacity){
+            std::copy(std::begin(container), std::end(container), std::begin(node.inlined));
+            container.clear();
+            freeOverflows.emplace_back(overflow);
+        }
+    }
+    template<class T, class Allocator, std::size_t InlineCapacity>
+    void CompactQuadtree<T,Allocator,InlineCapacity>::clear() noexcept{
+        nodes.resize(1);
+        nodes[0] = Node();
+        freeOverflows.clear();
+        for(auto i=0u;i<overflows.size();++i){
+            overflows[i].clear();
+            freeOverflows.emplace_back(static_cast<std::uint32_t>(overflows.size() - 1 - i));
+        }
+    }
+    template<class T, class Allocator, std::size_t InlineCapacity>
+    typename CompactQuadtree<T,Allocator,InlineCapacity>::Container CompactQuadtree<T,Allocator,InlineCapacity>::retrieve(T* e) const{
+        Container entitiesList(nodes.get_allocator());
+        retrieve(e, entitiesList);
+        return entitiesList;
+    }
+    template<class T, class Allocator, std::size_t InlineCapacity>
+    void CompactQuadtree<T,Allocator,InlineCapacity>::retrieve(T* e, Container& eList) const{
+        auto begin = eList.size();
+        std::uint32_t index = 0;
+        Rectf nodeBounds = bounds;
+        while(true){
+            const auto& node = nodes[index];
+            if(node.size <= InlineCapacity){
+                eList.insert(std::end(eList), node.inlined, node.inlined + node.size);
+            }else{
+                const auto& container = overflows[node.overflow];
+                eList.insert(std::end(eList), std::begin(container), std::end(container));
+            }
+            if(node.firstChild == 0){
+                break;
+            }
+            int child = getIndex(nodeBounds, *e);
+            if(child == -1){
+                break;
+            }
+            index = node.firstChild + child;
+            nodeBounds = getChildBounds(nodeBounds, child);
+        }
+        std::sort(std::begin(eList) + begin, std::end(eList));
+    }
+    template<class T, class Allocator, std::size_t InlineCapacity>
+    CompactQuadtree<T,Allocator,InlineCapacity>& CompactQuadtree<T,Allocator,InlineCapacity>::setBounds(const Rectf& bounds) noexcept{
+        this->bounds = bounds;
+        return *this;
+    }
+    template<class T, class Allocator, std::size_t InlineCapacity>
+    Rectf CompactQuadtree<T,Allocator,InlineCapacity>::getBounds() const noexcept{
+        return bounds;
+    }
+    template<class T, class Allocator, std::size_t InlineCapacity>
+    CompactQuadtree<T,Allocator,InlineCapacity>& CompactQuadtree<T,Allocator,InlineCapacity>::setMaxCapacity(std::size_t maxCap) noexcept{
+        maxCapacity = maxCap;
+        return *this;
+    }
+    template<class T, class Allocator, std::size_t InlineCapacity>
+    const std::size_t& CompactQuadtree<T,Allocator,InlineCapacity>::getMaxCapacity() const noexcept{
+        return maxCapacity;
+    }
+    template<class T, class Allocator, std::size_t InlineCapacity>
+    CompactQuadtree<T,Allocator,InlineCapacity>& CompactQuadtree<T,Allocator,InlineCapacity>::setMaxLevel(std::size_t maxLvl) noexcept{
+        maxLevel = maxLvl;
+        return *this;
+    }
+    template<class T, class Allocator, std::size_t InlineCapacity>
+    const std::size_t& CompactQuadtree<T,Allocator,InlineCapacity>::getMaxLevel() const noexcept{
+        return maxLevel;
+    }
+    template<class T, class Allocator, std::size_t InlineCapacity>
+    bool CompactQuadtree<T,Allocator,InlineCapacity>::isSplit() const noexcept{
+        return nodes[0].firstChild != 0;
+    }
+    template<class T, class Allocator, std::size_t InlineCapacity>
+    std::size_t CompactQuadtree<T,Allocator,InlineCapacity>::getNodeCount() const noexcept{
+        return nodes.size();
+    }
+    template<class T, class Allocator, std::size_t InlineCapacity>
+    std::size_t CompactQuadtree<T,Allocator,InlineCapacity>::getMemoryUsage() const noexcept{
+        std::size_t bytes = sizeof(CompactQuadtree);
+        bytes += nodes.capacity() * sizeof(Node);
+        bytes += overflows.capacity() * sizeof(Container);
+        bytes += freeOverflows.capacity() * sizeof(std::uint32_t);
+        for(const auto& container:overflows){
+            bytes += container.capacity() * sizeof(T*);
+        }
+        return bytes;
+    }
+    template<class T, class Allocator, std::size_t InlineCapacity>
+    Allocator CompactQuadtree<T,Allocator,InlineCapacity>::getAllocator() const noexcept{
+        return nodes.get_allocator();
+    }
+    template<class T, class Allocator, std::size_t InlineCapacity>
+    Rectf CompactQuadtree<T,Allocator,InlineCapacity>::getChildBounds(const Rectf& bounds, std::size_t index) noexcept{
+        int subWidth = static_cast<int>(bounds.width / 2);
+        int subHeight = static_cast<int>(bounds.height / 2);
+        int x = static_cast<int>(bounds.left);
+        int y = static_cast<int>(bounds.top);
+        switch(index){
+            case 0:
+                return Rectf(x, y, subWidth, subHeight);
+            case 1:
+                return Rectf(x + subWidth, y, subWidth, subHeight);
+            case 2:
+                return Rectf(x, y + subHeight, subWidth, subHeight);
+            default:
+                return Rectf(x + subWidth, y + subHeight, subWidth, subHeight);
+        }
+    }
+    template<class T, class Allocator, std::size_t InlineCapacity>
+    int CompactQuadtree<T,Allocator,InlineCapacity>::getIndex(const Rectf& bounds, const T& e) noexcept{
+        auto pos = e.getPosition();
+        for(auto i=0u;i<4u;++i){
+            if(getChildBounds(bounds, i).contains(pos.left, pos.top)){
+                return i;
+            }
+        }
+        return -1;
+    }
+}
+#endif // SPPAR_COMPACT_QUADTREE_HPP
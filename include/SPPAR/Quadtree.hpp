@@ -26,6 +26,9 @@
 #include <array>
 #include <algorithm>
 #include <memory>
+#include <limits>
+#include <cmath>
+#include <atomic>
 #include <type_traits>
 
 #include "Rect.hpp"
@@ -36,23 +39,61 @@ namespace SPPAR{
      * @brief Divides the space into four rectangles.
      * 
      * @tparam T class that will be used, it will be saved as a pointer
+     * @tparam Allocator allocator of T*, it is also rebound to allocate the nodes
+     * so the whole tree can live in a std::pmr::memory_resource or a custom pool.
      * @author Cristian Glez <Cristian.glez.m@gmail.com>
      * @version 0.3
      */
-    template<class T>
+    template<class T, class Allocator = std::allocator<T*>>
     class Quadtree{
             static_assert(std::is_member_function_pointer<decltype(&T::getPosition)>::value, "T need to have function 'const Rectf& getPosition() const'");
         public:
             /**
              * @brief Container that uses the quadtree.
-             * we use a std::vector<T*> @todo explain more
+             * we use a std::vector<T*> with the allocator of the quadtree.
              */
-            using Container = typename std::vector<T*>;
+            using Container = typename std::vector<T*, Allocator>;
+            /**
+             * @brief Ray used by the batched raycast.
+             */
+            struct Ray{
+                Vector2f origin;
+                Vector2f direction;
+                float maxDistance;
+            };
+            /**
+             * @brief Result of a raycast, entity is nullptr if nothing was hit.
+             */
+            struct RayHit{
+                T* entity = nullptr;
+                float distance = 0;
+            };
+            /**
+             * @class Finger
+             * @brief Remembers the nodes visited by the last retrieve that used it, the next
+             * retrieve starts from the last node and only climbs until the position fits.
+             * It is reset when the quadtree version changes (nodes destroyed by clear), versions
+             * are unique across quadtrees so a finger is never valid for a rebuilt quadtree.
+             */
+            class Finger{
+                public:
+                    /**
+                     * @brief Constructor
+                     * @param alloc Allocator used for the visited nodes.
+                     */
+                    explicit Finger(const Allocator& alloc = Allocator());
+                private:
+                    friend class Quadtree;
+                    const Quadtree* tree;
+                    std::size_t version;
+                    std::vector<Quadtree*, typename std::allocator_traits<Allocator>::template rebind_alloc<Quadtree*>> path;
+            };
             /**
              * @brief Constructor
              * @param bounds Rect bounds of the quadtree.
+             * @param alloc Allocator used for the nodes and its containers.
              */
-            Quadtree(const Rectf& bounds);
+            Quadtree(const Rectf& bounds, const Allocator& alloc = Allocator());
             /**
              * @brief adds a pointer from the entity and adds it to its appropriate node, 
              * if it cannot fit within a node, it will be inserted at the parent.
@@ -87,6 +128,45 @@ namespace SPPAR{
              * @return Container
              */
             Container retrieve(T* e) noexcept;
+            /**
+             * @brief retrieve that starts from the nodes remembered by finger, for
+             * queries with almost the same position every frame.
+             * @param e T* Entity to check.
+             * @param eList Quadtree::Container& to add the entities from the same space of the one provided.
+             * @param finger Finger& cache of the last nodes visited, it is updated.
+             */
+            void retrieve(T* e, Container& eList, Finger& finger) noexcept;
+            /**
+             * @brief Overload for retrieve with finger without the Container.
+             * @param e T*
+             * @param finger Finger&
+             * @return Container
+             */
+            Container retrieve(T* e, Finger& finger) noexcept;
+            /**
+             * @brief Finds the closest entity hit by the ray, nodes are visited front to back
+             * and the traversal stops as soon as no closer hit is possible.
+             * @param origin Vector2f start of the ray.
+             * @param direction Vector2f direction of the ray, it doesn't need to be normalized.
+             * @param maxDistance float max distance the ray travels.
+             * @return RayHit closest entity hit and its distance from the origin.
+             */
+            RayHit raycast(const Vector2f& origin, const Vector2f& direction, float maxDistance) const noexcept;
+            /**
+             * @brief Batched raycast, the rays are traversed together so coherent rays
+             * share the node visits.
+             * @param rays const std::vector<Ray>& rays to cast.
+             * @param hits std::vector<RayHit>& closest hit of each ray, same order as rays.
+             */
+            void raycast(const std::vector<Ray>& rays, std::vector<RayHit>& hits) const noexcept;
+            /**
+             * @brief Walks this quadtree and other at once and calls callback(T*, U*) for every pair of
+             * entities whose bounds overlap (touching counts), pairs of nodes that don't overlap are skipped.
+             * @param other const Quadtree<U,UAllocator>& quadtree to check against, i.e. static entities.
+             * @param callback void(T*, U*) called once for every candidate pair.
+             */
+            template<class U, class UAllocator, class Callback>
+            void intersect(const Quadtree<U,UAllocator>& other, Callback&& callback) const;
         #ifdef RENDER_QTREE
             /**
              * @brief Lets you see the borders of the quadtree
@@ -97,9 +177,9 @@ namespace SPPAR{
             /**
              * @brief sets the new bounds and updates the nodes if it has been split.
              * @param bounds
-             * @return Quadtree<T>&
+             * @return Quadtree<T,Allocator>&
              */
-            Quadtree<T>& setBounds(const Rectf& bounds) noexcept;
+            Quadtree<T,Allocator>& setBounds(const Rectf& bounds) noexcept;
             /**
              * @brief getter for bounds
              * @return Rectf
@@ -113,9 +193,9 @@ namespace SPPAR{
             /**
              * @brief sets the new max capacity.
              * @param maxCap
-             * @return Quadtree<T,BinaryPredicate>&
+             * @return Quadtree<T,Allocator>&
              */
-            Quadtree<T>& setMaxCapacity(std::size_t maxCap) noexcept;
+            Quadtree<T,Allocator>& setMaxCapacity(std::size_t maxCap) noexcept;
             /**
              * @brief getter for maxCapacity
              * @return std::size_t
@@ -124,9 +204,9 @@ namespace SPPAR{
             /**
              * @brief sets the new max Level
              * @param maxLvl
-             * @return Quadtree<T,BinaryPredicate>&
+             * @return Quadtree<T,Allocator>&
              */
-            Quadtree<T>& setMaxLevel(std::size_t maxLvl) noexcept;
+            Quadtree<T,Allocator>& setMaxLevel(std::size_t maxLvl) noexcept;
             /**
              * @brief getter for maxLevel
              * @return size_t
@@ -136,25 +216,61 @@ namespace SPPAR{
              * @brief getter for node
              * @return Quadtree
              */
-            Quadtree<T>& getNode(std::size_t index) noexcept;
+            Quadtree<T,Allocator>& getNode(std::size_t index) noexcept;
             /**
              * @brief Direct Access for Quadtree nodes, it doesn't check bounds or if it is splited.
              * @return Quadtree &
              */
-            Quadtree<T>& operator[](std::size_t index) noexcept;
+            Quadtree<T,Allocator>& operator[](std::size_t index) noexcept;
             /**
              * @brief checks if it has been splited
              * @return bool
              */
             bool isSplit() const noexcept;
-            ~Quadtree() = default;
+            /**
+             * @brief bytes used by the quadtree, nodes and containers included.
+             * @return std::size_t
+             */
+            std::size_t getMemoryUsage() const noexcept;
+            /**
+             * @brief getter for the allocator
+             * @return Allocator
+             */
+            Allocator getAllocator() const noexcept;
+            ~Quadtree();
         private:
+            template<class, class>
+            friend class Quadtree;
+            template<class U>
+            using Rebind = typename std::allocator_traits<Allocator>::template rebind_alloc<U>;
+            using NodeAllocator = Rebind<Quadtree>;
+            using RayEntry = std::pair<std::size_t, float>;
+            using NodeTraits = std::allocator_traits<NodeAllocator>;
+            /**
+             * @brief Deleter for the nodes, it uses the allocator of the node it deletes.
+             */
+            struct NodeDeleter{
+                void operator()(Quadtree* node) const noexcept;
+            };
             /**
              * @brief Private constructor for nodes inside the quadtree.
              * @param level std::size_t the level it will be.
              * @param bounds Rect bounds of the node.
+             * @param version std::size_t* version of the quadtree, owned by the root.
+             * @param alloc Allocator of the parent.
              */
-            Quadtree(std::size_t level,const Rectf& bounds);
+            Quadtree(std::size_t level, const Rectf& bounds, std::size_t* version, const Allocator& alloc);
+            /**
+             * @brief creates a node with the allocator of the quadtree.
+             * @param bounds Rect bounds of the node.
+             * @return Quadtree* 
+             */
+            Quadtree* createNode(const Rectf& bounds);
+            /**
+             * @brief gives a version that no quadtree has used yet.
+             * @return std::size_t
+             */
+            static std::size_t nextVersion() noexcept;
             /**
              * @brief getter for the index where T is in.
              * @param e
@@ -165,58 +281,148 @@ namespace SPPAR{
              * @brief private method to subdivide the quadtree.
              */
             void split();
+            /**
+             * @brief checks if the node and its subnodes have no entities.
+             * @return bool
+             */
+            bool isEmpty() const noexcept;
+            /**
+             * @brief grows looseBounds to include the given bounds.
+             * @param b Rectf
+             */
+            void expandLooseBounds(const Rectf& b) noexcept;
+            /**
+             * @brief recursive raycast, direction must be normalized.
+             * @param origin Vector2f
+             * @param direction Vector2f
+             * @param hit RayHit& closest hit found so far.
+             */
+            void raycast(const Vector2f& origin, const Vector2f& direction, RayHit& hit) const noexcept;
+            /**
+             * @brief recursive batched raycast over the rays in active[begin, end).
+             * @param rays const std::vector<Ray>&
+             * @param directions const std::vector<Vector2f>& normalized directions of the rays.
+             * @param active std::vector<RayEntry>& index of the ray and where it enters the node, used as a stack.
+             * @param begin std::size_t
+             * @param end std::size_t
+             * @param hits std::vector<RayHit>&
+             */
+            void raycast(const std::vector<Ray>& rays, const std::vector<Vector2f, Rebind<Vector2f>>& directions,
+                         std::vector<RayEntry, Rebind<RayEntry>>& active, std::size_t begin, std::size_t end,
+                         std::vector<RayHit>& hits) const noexcept;
+            /**
+             * @brief checks if two rects overlap, unlike Rect::intersects touching counts.
+             * @param a Rectf
+             * @param b Rectf
+             * @return bool
+             */
+            static bool overlaps(const Rectf& a, const Rectf& b) noexcept;
+            /**
+             * @brief calls fn(T*) for every entity of the node and its subnodes that overlaps r.
+             * @param r Rectf
+             * @param fn void(T*)
+             */
+            template<class Fn>
+            void forEachOverlap(const Rectf& r, Fn&& fn) const;
+            /**
+             * @brief recursive intersect for a pair of nodes.
+             * @param other const Quadtree<U,UAllocator>& node of the other quadtree.
+             * @param callback void(T*, U*)
+             */
+            template<class U, class UAllocator, class Callback>
+            void intersectNodes(const Quadtree<U,UAllocator>& other, Callback& callback) const;
         private:
             std::size_t maxCapacity;
             std::size_t maxLevel;
             std::size_t level;
-            std::array<std::unique_ptr<Quadtree>,4> nodes;
+            std::array<std::unique_ptr<Quadtree, NodeDeleter>,4> nodes;
             Rectf bounds;
+            Rectf looseBounds;
             Quadtree::Container entities;
+            std::size_t* version;
     };
 //////////////////////////////////////////////////
 //////// Quadtree Impl
 //////////////////////////////////////////////////
-    template<class T>
-    Quadtree<T>::Quadtree(std::size_t level, const Rectf& bounds)
+    template<class T, class Allocator>
+    Quadtree<T,Allocator>::Finger::Finger(const Allocator& alloc)
+    : tree(nullptr)
+    , version(0)
+    , path(alloc){}
+    template<class T, class Allocator>
+    Quadtree<T,Allocator>::Quadtree(std::size_t level, const Rectf& bounds, std::size_t* version, const Allocator& alloc)
     : maxCapacity(15)
     , maxLevel(100)
     , level(level)
     , nodes()
     , bounds(bounds)
-    , entities(){
+    , looseBounds()
+    , entities(alloc)
+    , version(version){
         for(auto i=0u;i<nodes.size();++i){
             nodes[i] = nullptr;
         }
     }
-    template<class T>
-    void Quadtree<T>::split(){
+    template<class T, class Allocator>
+    Quadtree<T,Allocator>* Quadtree<T,Allocator>::createNode(const Rectf& bounds){
+        NodeAllocator alloc(entities.get_allocator());
+        auto node = NodeTraits::allocate(alloc, 1);
+        ::new(static_cast<void*>(node)) Quadtree((level+1), bounds, version, entities.get_allocator());
+        return node;
+    }
+    template<class T, class Allocator>
+    void Quadtree<T,Allocator>::NodeDeleter::operator()(Quadtree* node) const noexcept{
+        NodeAllocator alloc(node->entities.get_allocator());
+        node->~Quadtree();
+        NodeTraits::deallocate(alloc, node, 1);
+    }
+    template<class T, class Allocator>
+    void Quadtree<T,Allocator>::split(){
         int subWidth = static_cast<int>(bounds.width / 2);
         int subHeight = static_cast<int>(bounds.height / 2);
         int x = static_cast<int>(bounds.left);
         int y = static_cast<int>(bounds.top);
-        nodes[0].reset(new Quadtree<T>((level+1), Rectf(x, y, subWidth, subHeight)));
-        nodes[1].reset(new Quadtree<T>((level+1), Rectf(x + subWidth, y, subWidth, subHeight)));
-        nodes[2].reset(new Quadtree<T>((level+1), Rectf(x, y + subHeight, subWidth, subHeight)));
-        nodes[3].reset(new Quadtree<T>((level+1), Rectf(x + subWidth, y + subHeight, subWidth, subHeight)));
+        nodes[0].reset(createNode(Rectf(x, y, subWidth, subHeight)));
+        nodes[1].reset(createNode(Rectf(x + subWidth, y, subWidth, subHeight)));
+        nodes[2].reset(createNode(Rectf(x, y + subHeight, subWidth, subHeight)));
+        nodes[3].reset(createNode(Rectf(x + subWidth, y + subHeight, subWidth, subHeight)));
         for(auto i=0u;i<nodes.size();++i){
             nodes[i]->setMaxCapacity(maxCapacity);
             nodes[i]->setMaxLevel(maxLevel);
         }
     }
-    template<class T>
-    Quadtree<T>::Quadtree(const Rectf& bounds)
+    template<class T, class Allocator>
+    Quadtree<T,Allocator>::Quadtree(const Rectf& bounds, const Allocator& alloc)
     : maxCapacity(15)
     , maxLevel(100)
     , level(0)
     , nodes()
     , bounds(bounds)
-    , entities(){
+    , looseBounds()
+    , entities(alloc)
+    , version(nullptr){
         for(auto i=0u;i<nodes.size();++i){
             nodes[i] = nullptr;
         }
+        Rebind<std::size_t> versionAlloc(alloc);
+        version = std::allocator_traits<Rebind<std::size_t>>::allocate(versionAlloc, 1);
+        *version = nextVersion();
+    }
+    template<class T, class Allocator>
+    Quadtree<T,Allocator>::~Quadtree(){
+        if(level == 0){
+            Rebind<std::size_t> versionAlloc(entities.get_allocator());
+            std::allocator_traits<Rebind<std::size_t>>::deallocate(versionAlloc, version, 1);
+        }
+    }
+    template<class T, class Allocator>
+    std::size_t Quadtree<T,Allocator>::nextVersion() noexcept{
+        static std::atomic<std::size_t> versions(0);
+        return ++versions;
     }
-    template<class T>
-    void Quadtree<T>::insert(T* e) noexcept{
+    template<class T, class Allocator>
+    void Quadtree<T,Allocator>::insert(T* e) noexcept{
+        expandLooseBounds(e->getPosition());
         if(isSplit()){
             int index = getIndex(*e);
             if(index != -1){
@@ -240,12 +446,12 @@ namespace SPPAR{
                 }),std::end(entities));
         }
     }
-    template<class T>
-    typename Quadtree<T>::Container& Quadtree<T>::getEntities() noexcept{
+    template<class T, class Allocator>
+    typename Quadtree<T,Allocator>::Container& Quadtree<T,Allocator>::getEntities() noexcept{
         return entities;
     }
-    template<class T>
-    typename Quadtree<T>::Container& Quadtree<T>::getEntities(std::size_t index) noexcept{
+    template<class T, class Allocator>
+    typename Quadtree<T,Allocator>::Container& Quadtree<T,Allocator>::getEntities(std::size_t index) noexcept{
         if(index == -1){
             return entities;
         }else if(isSplit()){
@@ -253,25 +459,61 @@ namespace SPPAR{
         }
         return entities;
     }
-    template<class T>
-    void Quadtree<T>::clear() noexcept{
+    template<class T, class Allocator>
+    void Quadtree<T,Allocator>::clear() noexcept{
         entities.clear();
+        looseBounds = Rectf();
         if(isSplit()){
+            *version = nextVersion();
             for(auto i=0u;i<nodes.size();++i) {
                 nodes[i]->clear();
                 nodes[i] = nullptr;
             }
         }
     }
-    template<class T>
-    typename Quadtree<T>::Container Quadtree<T>::retrieve(T* e) noexcept{
-        typename Quadtree<T>::Container entitiesList;
+    template<class T, class Allocator>
+    typename Quadtree<T,Allocator>::Container Quadtree<T,Allocator>::retrieve(T* e) noexcept{
+        typename Quadtree<T,Allocator>::Container entitiesList(entities.get_allocator());
         retrieve(e, entitiesList);
         return entitiesList;
     }
-    template<class T>
-    void Quadtree<T>::retrieve(T* e, Container& eList) noexcept{
-        typename Quadtree<T>::Container internDst;
+    template<class T, class Allocator>
+    typename Quadtree<T,Allocator>::Container Quadtree<T,Allocator>::retrieve(T* e, Finger& finger) noexcept{
+        typename Quadtree<T,Allocator>::Container entitiesList(entities.get_allocator());
+        retrieve(e, entitiesList, finger);
+        return entitiesList;
+    }
+    template<class T, class Allocator>
+    void Quadtree<T,Allocator>::retrieve(T* e, Container& eList, Finger& finger) noexcept{
+        auto pos = e->getPosition();
+        if(finger.tree != this || finger.version != *version || finger.path.empty()){
+            finger.tree = this;
+            finger.version = *version;
+            finger.path.clear();
+            finger.path.emplace_back(this);
+        }else{
+            // below the first level the nodes are inside their parent,
+            // so the first node that contains e is on the path of e.
+            while(finger.path.size() > 1 && !finger.path.back()->bounds.contains(pos.left, pos.top)){
+                finger.path.pop_back();
+            }
+        }
+        auto node = finger.path.back();
+        int index = node->getIndex(*e);
+        while(index != -1){
+            node = node->nodes[index].get();
+            finger.path.emplace_back(node);
+            index = node->getIndex(*e);
+        }
+        auto begin = eList.size();
+        for(auto n:finger.path){
+            eList.insert(std::end(eList), std::begin(n->entities), std::end(n->entities));
+        }
+        std::sort(std::begin(eList) + begin, std::end(eList));
+    }
+    template<class T, class Allocator>
+    void Quadtree<T,Allocator>::retrieve(T* e, Container& eList) noexcept{
+        typename Quadtree<T,Allocator>::Container internDst(entities.get_allocator());
         int index = getIndex(*e);
         if(index != -1 && isSplit()){
             nodes[index]->retrieve(e,internDst);
@@ -282,9 +524,213 @@ namespace SPPAR{
                     std::begin(internDst),std::end(internDst),
                     std::back_inserter(eList));
     }
+    template<class T, class Allocator>
+    typename Quadtree<T,Allocator>::RayHit Quadtree<T,Allocator>::raycast(const Vector2f& origin, const Vector2f& direction, float maxDistance) const noexcept{
+        RayHit hit;
+        hit.distance = maxDistance;
+        float length = std::sqrt(direction.x * direction.x + direction.y * direction.y);
+        if(length == 0 || isEmpty()){
+            return hit;
+        }
+        float tNear, tFar;
+        Vector2f dir(direction.x / length, direction.y / length);
+        if(looseBounds.intersects(origin, dir, tNear, tFar) && tNear <= hit.distance){
+            raycast(origin, dir, hit);
+        }
+        return hit;
+    }
+    template<class T, class Allocator>
+    void Quadtree<T,Allocator>::raycast(const std::vector<Ray>& rays, std::vector<RayHit>& hits) const noexcept{
+        hits.assign(rays.size(), RayHit());
+        std::vector<Vector2f, Rebind<Vector2f>> directions(rays.size(), Vector2f(), entities.get_allocator());
+        std::vector<RayEntry, Rebind<RayEntry>> active(entities.get_allocator());
+        active.reserve(rays.size());
+        for(auto i=0u;i<rays.size();++i){
+            hits[i].distance = rays[i].maxDistance;
+            const auto& d = rays[i].direction;
+            float length = std::sqrt(d.x * d.x + d.y * d.y);
+            if(length == 0 || isEmpty()){
+                continue;
+            }
+            directions[i] = Vector2f(d.x / length, d.y / length);
+            float tNear, tFar;
+            if(looseBounds.intersects(rays[i].origin, directions[i], tNear, tFar) && tNear <= hits[i].distance){
+                active.emplace_back(i, tNear);
+            }
+        }
+        if(!active.empty()){
+            raycast(rays, directions, active, 0, active.size(), hits);
+        }
+    }
+    template<class T, class Allocator>
+    void Quadtree<T,Allocator>::raycast(const Vector2f& origin, const Vector2f& direction, RayHit& hit) const noexcept{
+        float tNear, tFar;
+        for(auto e:entities){
+            if(e->getPosition().intersects(origin, direction, tNear, tFar) &&
+                (tNear < hit.distance || (hit.entity == nullptr && tNear == hit.distance))){
+                hit.entity = e;
+                hit.distance = tNear;
+            }
+        }
+        if(!isSplit()){
+            return;
+        }
+        std::array<std::pair<float,std::size_t>,4> order;
+        std::size_t count = 0;
+        for(auto i=0u;i<nodes.size();++i){
+            if(!nodes[i]->isEmpty() && nodes[i]->looseBounds.intersects(origin, direction, tNear, tFar)){
+                auto j = count++;
+                for(;j > 0 && order[j - 1].first > tNear;--j){
+                    order[j] = order[j - 1];
+                }
+                order[j] = std::make_pair(tNear, i);
+            }
+        }
+        for(auto i=0u;i<count;++i){
+            if(order[i].first > hit.distance){
+                break;
+            }
+            nodes[order[i].second]->raycast(origin, direction, hit);
+        }
+    }
+    template<class T, class Allocator>
+    void Quadtree<T,Allocator>::raycast(const std::vector<Ray>& rays, const std::vector<Vector2f, Rebind<Vector2f>>& directions,
+                                        std::vector<RayEntry, Rebind<RayEntry>>& active, std::size_t begin, std::size_t end,
+                                        std::vector<RayHit>& hits) const noexcept{
+        float tNear, tFar;
+        for(auto e:entities){
+            auto pos = e->getPosition();
+            for(auto i=begin;i<end;++i){
+                auto r = active[i].first;
+                if(pos.intersects(rays[r].origin, directions[r], tNear, tFar) &&
+                    (tNear < hits[r].distance || (hits[r].entity == nullptr && tNear == hits[r].distance))){
+                    hits[r].entity = e;
+                    hits[r].distance = tNear;
+                }
+            }
+        }
+        if(!isSplit()){
+            return;
+        }
+        // the packets of the children are built in one pass and visited
+        // in order of the nearest entry of any of their rays.
+        struct Packet{
+            float nearest;
+            std::size_t begin;
+            std::size_t end;
+            std::size_t node;
+        };
+        std::array<Packet,4> order;
+        std::size_t count = 0;
+        auto packetsBegin = active.size();
+        for(auto i=0u;i<nodes.size();++i){
+            if(nodes[i]->isEmpty()){
+                continue;
+            }
+            float nearest = std::numeric_limits<float>::max();
+            auto childBegin = active.size();
+            for(auto j=begin;j<end;++j){
+                auto r = active[j].first;
+                if(nodes[i]->looseBounds.intersects(rays[r].origin, directions[r], tNear, tFar) && tNear <= hits[r].distance){
+                    active.emplace_back(r, tNear);
+                    nearest = std::min(nearest, tNear);
+                }
+            }
+            if(childBegin != active.size()){
+                auto k = count++;
+                for(;k > 0 && order[k - 1].nearest > nearest;--k){
+                    order[k] = order[k - 1];
+                }
+                order[k] = Packet{nearest, childBegin, active.size(), i};
+            }
+        }
+        for(auto i=0u;i<count;++i){
+            // drop the rays that found a hit closer than the child while visiting the previous ones.
+            auto childEnd = order[i].begin;
+            for(auto j=order[i].begin;j<order[i].end;++j){
+                if(active[j].second <= hits[active[j].first].distance){
+                    active[childEnd++] = active[j];
+                }
+            }
+            if(childEnd != order[i].begin){
+                nodes[order[i].node]->raycast(rays, directions, active, order[i].begin, childEnd, hits);
+            }
+        }
+        active.resize(packetsBegin);
+    }
+    template<class T, class Allocator>
+    template<class U, class UAllocator, class Callback>
+    void Quadtree<T,Allocator>::intersect(const Quadtree<U,UAllocator>& other, Callback&& callback) const{
+        intersectNodes(other, callback);
+    }
+    template<class T, class Allocator>
+    template<class U, class UAllocator, class Callback>
+    void Quadtree<T,Allocator>::intersectNodes(const Quadtree<U,UAllocator>& other, Callback& callback) const{
+        if(isEmpty() || other.isEmpty() || !overlaps(looseBounds, other.looseBounds)){
+            return;
+        }
+        for(auto a:entities){
+            auto aBounds = a->getPosition();
+            if(!overlaps(aBounds, other.looseBounds)){
+                continue;
+            }
+            for(auto b:other.entities){
+                if(overlaps(aBounds, b->getPosition())){
+                    callback(a, b);
+                }
+            }
+            if(other.isSplit()){
+                for(auto i=0u;i<other.nodes.size();++i){
+                    other.nodes[i]->forEachOverlap(aBounds, [&](U* b){ callback(a, b); });
+                }
+            }
+        }
+        if(isSplit()){
+            for(auto b:other.entities){
+                auto bBounds = b->getPosition();
+                if(!overlaps(bBounds, looseBounds)){
+                    continue;
+                }
+                for(auto i=0u;i<nodes.size();++i){
+                    nodes[i]->forEachOverlap(bBounds, [&](T* a){ callback(a, b); });
+                }
+            }
+            if(other.isSplit()){
+                for(auto i=0u;i<nodes.size();++i){
+                    for(auto j=0u;j<other.nodes.size();++j){
+                        nodes[i]->intersectNodes(*other.nodes[j], callback);
+                    }
+                }
+            }
+        }
+    }
+    template<class T, class Allocator>
+    template<class Fn>
+    void Quadtree<T,Allocator>::forEachOverlap(const Rectf& r, Fn&& fn) const{
+        if(isEmpty() || !overlaps(r, looseBounds)){
+            return;
+        }
+        for(auto e:entities){
+            if(overlaps(r, e->getPosition())){
+                fn(e);
+            }
+        }
+        if(isSplit()){
+            for(auto i=0u;i<nodes.size();++i){
+                nodes[i]->forEachOverlap(r, fn);
+            }
+        }
+    }
+    template<class T, class Allocator>
+    bool Quadtree<T,Allocator>::overlaps(const Rectf& a, const Rectf& b) noexcept{
+        return std::min(a.left, a.left + a.width) <= std::max(b.left, b.left + b.width) &&
+               std::min(b.left, b.left + b.width) <= std::max(a.left, a.left + a.width) &&
+               std::min(a.top, a.top + a.height) <= std::max(b.top, b.top + b.height) &&
+               std::min(b.top, b.top + b.height) <= std::max(a.top, a.top + a.height);
+    }
 #ifdef RENDER_QTREE
-    template<class T>
-    void Quadtree<T>::render(sf::RenderWindow& win){
+    template<class T, class Allocator>
+    void Quadtree<T,Allocator>::render(sf::RenderWindow& win){
         sf::RectangleShape boundsShape(sf::Vector2f(bounds.width,bounds.height));
         boundsShape.setPosition(bounds.left,bounds.top);
         int b,g,r;
@@ -306,8 +752,8 @@ namespace SPPAR{
         }
     }
 #endif
-    template<class T>
-    Quadtree<T>& Quadtree<T>::setBounds(const Rectf& bounds) noexcept{
+    template<class T, class Allocator>
+    Quadtree<T,Allocator>& Quadtree<T,Allocator>::setBounds(const Rectf& bounds) noexcept{
         this->bounds = bounds;
         if(isSplit()){
             int subWidth = static_cast<int>(bounds.width / 2);
@@ -321,12 +767,12 @@ namespace SPPAR{
         }
         return *this;
     }
-    template<class T>
-    Rectf Quadtree<T>::getBounds() const noexcept{
+    template<class T, class Allocator>
+    Rectf Quadtree<T,Allocator>::getBounds() const noexcept{
         return bounds;
     }
-    template<class T>
-    Rectf Quadtree<T>::getBounds(int index) const noexcept{
+    template<class T, class Allocator>
+    Rectf Quadtree<T,Allocator>::getBounds(int index) const noexcept{
         if(index == -1){
             return bounds;
         }else if(isSplit()){
@@ -334,8 +780,8 @@ namespace SPPAR{
         }
         return bounds;
     }
-    template<class T>
-    Quadtree<T>& Quadtree<T>::setMaxCapacity(std::size_t maxCap) noexcept{
+    template<class T, class Allocator>
+    Quadtree<T,Allocator>& Quadtree<T,Allocator>::setMaxCapacity(std::size_t maxCap) noexcept{
         maxCapacity = maxCap;
         if(isSplit()){
             for(auto i=0u;i<nodes.size();++i){
@@ -344,12 +790,12 @@ namespace SPPAR{
         }
         return *this;
     }
-    template<class T>
-    const std::size_t& Quadtree<T>::getMaxCapacity() const noexcept{
+    template<class T, class Allocator>
+    const std::size_t& Quadtree<T,Allocator>::getMaxCapacity() const noexcept{
         return maxCapacity;
     }
-    template<class T>
-    Quadtree<T>& Quadtree<T>::setMaxLevel(std::size_t maxLvl) noexcept{
+    template<class T, class Allocator>
+    Quadtree<T,Allocator>& Quadtree<T,Allocator>::setMaxLevel(std::size_t maxLvl) noexcept{
         maxLevel = maxLvl;
         if(isSplit()){
             for(auto i=0u;i<nodes.size();++i){
@@ -358,12 +804,12 @@ namespace SPPAR{
         }
         return *this;
     }
-    template<class T>
-    const std::size_t& Quadtree<T>::getMaxLevel() const noexcept{
+    template<class T, class Allocator>
+    const std::size_t& Quadtree<T,Allocator>::getMaxLevel() const noexcept{
         return maxLevel;
     }
-    template<class T>
-    int Quadtree<T>::getIndex(const T& e) const noexcept{
+    template<class T, class Allocator>
+    int Quadtree<T,Allocator>::getIndex(const T& e) const noexcept{
         int index = -1;
         if(!isSplit()){
             return index;
@@ -384,20 +830,52 @@ namespace SPPAR{
         }
         return index;
     }
-    template<class T>
-    Quadtree<T>& Quadtree<T>::getNode(std::size_t index) noexcept{
+    template<class T, class Allocator>
+    Quadtree<T,Allocator>& Quadtree<T,Allocator>::getNode(std::size_t index) noexcept{
         if(isSplit()){
             return *nodes[index].get();
         }
         return *this;
     }
-    template<class T>
-    Quadtree<T>& Quadtree<T>::operator[](std::size_t index) noexcept{
+    template<class T, class Allocator>
+    Quadtree<T,Allocator>& Quadtree<T,Allocator>::operator[](std::size_t index) noexcept{
         return *nodes[index].get();
     }
-    template<class T>
-    bool Quadtree<T>::isSplit() const noexcept{
+    template<class T, class Allocator>
+    bool Quadtree<T,Allocator>::isSplit() const noexcept{
         return (nodes[0] != nullptr);
     }
+    template<class T, class Allocator>
+    std::size_t Quadtree<T,Allocator>::getMemoryUsage() const noexcept{
+        std::size_t bytes = sizeof(Quadtree) + entities.capacity() * sizeof(T*);
+        if(isSplit()){
+            for(auto i=0u;i<nodes.size();++i){
+                bytes += nodes[i]->getMemoryUsage();
+            }
+        }
+        return bytes;
+    }
+    template<class T, class Allocator>
+    Allocator Quadtree<T,Allocator>::getAllocator() const noexcept{
+        return entities.get_allocator();
+    }
+    template<class T, class Allocator>
+    bool Quadtree<T,Allocator>::isEmpty() const noexcept{
+        return entities.empty() && !isSplit();
+    }
+    template<class T, class Allocator>
+    void Quadtree<T,Allocator>::expandLooseBounds(const Rectf& b) noexcept{
+        float minX = std::min(b.left, b.left + b.width);
+        float maxX = std::max(b.left, b.left + b.width);
+        float minY = std::min(b.top, b.top + b.height);
+        float maxY = std::max(b.top, b.top + b.height);
+        if(!isEmpty()){
+            minX = std::min(minX, looseBounds.left);
+            maxX = std::max(maxX, looseBounds.left + looseBounds.width);
+            minY = std::min(minY, looseBounds.top);
+            maxY = std::max(maxY, looseBounds.top + looseBounds.height);
+        }
+        looseBounds = Rectf(minX, minY, maxX - minX, maxY - minY);
+    }
 }
 #endif // SPPAR_QUADTREE_HPP
\ No newline at end of file
@@ -26,6 +26,10 @@
 #define RECT_HPP
 
 #include <algorithm>
+#include <limits>
+#include <utility>
+
+#include "Vector2.hpp"
 
 namespace SPPAR{
     /**
@@ -42,6 +46,15 @@ namespace SPPAR{
             bool contains(const Rect<T>& rectangle) const noexcept;
             bool intersects(const Rect<T>& rectangle) const noexcept;
             bool intersects(const Rect<T>& rectangle, Rect<T>& intersection) const noexcept;
+            /**
+             * @brief checks if the ray origin + t * direction (t >= 0) hits the rect, edges included.
+             * @param origin start of the ray.
+             * @param direction direction of the ray, it doesn't need to be normalized.
+             * @param tNear t where the ray enters the rect (0 if the origin is inside).
+             * @param tFar t where the ray leaves the rect.
+             * @return bool
+             */
+            bool intersects(const Vector2<T>& origin, const Vector2<T>& direction, T& tNear, T& tFar) const noexcept;
             ~Rect() = default;
         public:
             T top;
@@ -113,6 +126,34 @@ namespace SPPAR{
         }
     }
     template <typename T>
+    bool Rect<T>::intersects(const Vector2<T>& origin, const Vector2<T>& direction, T& tNear, T& tFar) const noexcept{
+        T minX = std::min(left, static_cast<T>(left + width));
+        T maxX = std::max(left, static_cast<T>(left + width));
+        T minY = std::min(top, static_cast<T>(top + height));
+        T maxY = std::max(top, static_cast<T>(top + height));
+        T tMin = 0;
+        T tMax = std::numeric_limits<T>::max();
+        auto slab = [&](T o, T d, T slabMin, T slabMax){
+            if(d == 0){
+                return (o >= slabMin) && (o <= slabMax);
+            }
+            T t1 = (slabMin - o) / d;
+            T t2 = (slabMax - o) / d;
+            if(t1 > t2){
+                std::swap(t1, t2);
+            }
+            tMin = std::max(tMin, t1);
+            tMax = std::min(tMax, t2);
+            return tMin <= tMax;
+        };
+        if(slab(origin.x, direction.x, minX, maxX) && slab(origin.y, direction.y, minY, maxY)){
+            tNear = tMin;
+            tFar = tMax;
+            return true;
+        }
+        return false;
+    }
+    template <typename T>
     inline bool operator==(const Rect<T>& left, const Rect<T>& right){
         return (left.left == right.left) && (left.width == right.width) &&
                (left.top == right.top) && (left.height == right.height);
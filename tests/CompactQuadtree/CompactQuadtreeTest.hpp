@@ -0,0 +1,91 @@
+#ifndef SPPAR_COMPACT_QUADTREE_TEST_HPP
+#define SPPAR_COMPACT_QUADTREE_TEST_HPP
+
+#include "../include/SPPAR/CompactQuadtree.hpp"
+#include "../Quadtree/QuadtreeTest.hpp"
+#include <vector>
+#include <random>
+#include <memory_resource>
+
+namespace SPPAR{
+    namespace test{
+        TEST(CompactQuadtreeTest,DefaultConstructor){
+            CompactQuadtree<Entity> qtree(Rectf(0,0,50,50));
+            EXPECT_EQ(Rectf(0,0,50,50),qtree.getBounds());
+            EXPECT_EQ(15u,qtree.getMaxCapacity());
+            EXPECT_EQ(100u,qtree.getMaxLevel());
+            EXPECT_FALSE(qtree.isSplit());
+            EXPECT_EQ(1u,qtree.getNodeCount());
+        }
+        TEST(CompactQuadtreeTest,RetrieveMatchesQuadtree){
+            Quadtree<Entity> qtree(Rectf(0,0,1000,1000));
+            CompactQuadtree<Entity> compact(Rectf(0,0,1000,1000));
+            qtree.setMaxCapacity(4).setMaxLevel(6);
+            compact.setMaxCapacity(4).setMaxLevel(6);
+            std::mt19937 rEngine(3);
+            std::uniform_int_distribution<int> dice(0,999);
+            std::vector<Entity> entities;
+            entities.reserve(2000);
+            for(auto i=0u;i<2000u;++i){
+                entities.emplace_back(i,dice(rEngine),dice(rEngine));
+                qtree.insert(&entities.back());
+                compact.insert(&entities.back());
+            }
+            EXPECT_TRUE(compact.isSplit());
+            for(auto& e:entities){
+                EXPECT_EQ(qtree.retrieve(&e),compact.retrieve(&e));
+            }
+        }
+        TEST(CompactQuadtreeTest,Clear){
+            CompactQuadtree<Entity> compact(Rectf(0,0,50,50));
+            compact.setMaxCapacity(1);
+            std::vector<Entity> entities;
+            entities.reserve(10);
+            for(auto i=0u;i<10u;++i){
+                entities.emplace_back(i,i * 5,i * 5);
+                compact.insert(&entities.back());
+            }
+            EXPECT_TRUE(compact.isSplit());
+            compact.clear();
+            EXPECT_FALSE(compact.isSplit());
+            EXPECT_EQ(1u,compact.getNodeCount());
+            EXPECT_TRUE(compact.retrieve(&entities[0]).empty());
+            compact.insert(&entities[3]);
+            auto found = compact.retrieve(&entities[0]);
+            ASSERT_EQ(1u,found.size());
+            EXPECT_EQ(3,found[0]->id);
+        }
+        TEST(CompactQuadtreeTest,MemoryUsage){
+            Quadtree<Entity> qtree(Rectf(0,0,1000,1000));
+            CompactQuadtree<Entity> compact(Rectf(0,0,1000,1000));
+            qtree.setMaxCapacity(1);
+            compact.setMaxCapacity(1);
+            std::mt19937 rEngine(5);
+            std::uniform_int_distribution<int> dice(0,999);
+            std::vector<Entity> entities;
+            entities.reserve(1000);
+            for(auto i=0u;i<1000u;++i){
+                entities.emplace_back(i,dice(rEngine),dice(rEngine));
+                qtree.insert(&entities.back());
+                compact.insert(&entities.back());
+            }
+            EXPECT_LT(compact.getMemoryUsage() * 2,qtree.getMemoryUsage());
+        }
+        TEST(CompactQuadtreeTest,Allocator){
+            std::pmr::monotonic_buffer_resource resource;
+            CompactQuadtree<Entity, std::pmr::polymorphic_allocator<Entity*>> compact(Rectf(0,0,50,50), &resource);
+            EXPECT_EQ(&resource, compact.getAllocator().resource());
+            std::vector<Entity> entities;
+            entities.reserve(50);
+            for(auto i=0u;i<50u;++i){
+                entities.emplace_back(i,i,i);
+                compact.insert(&entities.back());
+            }
+            auto found = compact.retrieve(&entities[0]);
+            EXPECT_EQ(&resource, found.get_allocator().resource());
+            EXPECT_FALSE(found.empty());
+        }
+    }
+}
+
+#endif // SPPAR_COMPACT_QUADTREE_TEST_HPP
@@ -8,6 +8,10 @@
 #include <chrono>
 #include <random>
 #include <ctime>
+#include <cmath>
+#include <memory_resource>
+#include <set>
+#include <optional>
 
 namespace SPPAR{
     namespace test{
@@ -98,6 +102,247 @@ namespace SPPAR{
             }
             EXPECT_TRUE(qtree->isSplit());
         }
+        TEST(QuadtreeTest,Raycast){
+            auto qtree = createQtree();
+            qtree->setMaxCapacity(1);
+            qtree->setMaxLevel(4);
+            std::vector<Entity> entities;
+            entities.reserve(4);
+            entities.emplace_back(0,40,10);
+            qtree->insert(&entities.back());
+            entities.emplace_back(1,20,10);
+            qtree->insert(&entities.back());
+            entities.emplace_back(2,30,10);
+            qtree->insert(&entities.back());
+            entities.emplace_back(3,20,40);
+            qtree->insert(&entities.back());
+            auto hit = qtree->raycast(Vector2f(0,10),Vector2f(2,0),100);
+            ASSERT_NE(nullptr,hit.entity);
+            EXPECT_EQ(1,hit.entity->id);
+            EXPECT_FLOAT_EQ(20,hit.distance);
+            hit = qtree->raycast(Vector2f(50,10),Vector2f(-1,0),100);
+            ASSERT_NE(nullptr,hit.entity);
+            EXPECT_EQ(0,hit.entity->id);
+            hit = qtree->raycast(Vector2f(0,10),Vector2f(1,0),15);
+            EXPECT_EQ(nullptr,hit.entity);
+            hit = qtree->raycast(Vector2f(20,0),Vector2f(0,1),100);
+            ASSERT_NE(nullptr,hit.entity);
+            EXPECT_EQ(1,hit.entity->id);
+            hit = qtree->raycast(Vector2f(0,25),Vector2f(1,0),100);
+            EXPECT_EQ(nullptr,hit.entity);
+        }
+        TEST(QuadtreeTest,RaycastBatch){
+            auto qtree = createQtree();
+            qtree->setMaxCapacity(2);
+            qtree->setMaxLevel(5);
+            std::mt19937 rEngine(42);
+            std::uniform_int_distribution<int> dice(0,49);
+            std::vector<Entity> entities;
+            entities.reserve(200);
+            for(auto i=0u;i<200u;++i){
+                entities.emplace_back(i,dice(rEngine),dice(rEngine));
+                entities.back().b.width = 1;
+                entities.back().b.height = 1;
+                qtree->insert(&entities.back());
+            }
+            std::vector<Quadtree<Entity>::Ray> rays;
+            for(auto i=0u;i<50u;++i){
+                rays.push_back({Vector2f(0,i + 0.5f),Vector2f(1,0.1f),60});
+            }
+            std::vector<Quadtree<Entity>::RayHit> hits;
+            qtree->raycast(rays,hits);
+            ASSERT_EQ(rays.size(),hits.size());
+            for(auto i=0u;i<rays.size();++i){
+                auto single = qtree->raycast(rays[i].origin,rays[i].direction,rays[i].maxDistance);
+                float best = rays[i].maxDistance;
+                bool found = false;
+                auto length = std::sqrt(1 + 0.1f * 0.1f);
+                Vector2f dir(1 / length, 0.1f / length);
+                for(auto& e:entities){
+                    float tNear, tFar;
+                    if(e.b.intersects(rays[i].origin,dir,tNear,tFar) && tNear <= best){
+                        best = tNear;
+                        found = true;
+                    }
+                }
+                EXPECT_EQ(found,hits[i].entity != nullptr);
+                EXPECT_EQ(single.entity != nullptr,hits[i].entity != nullptr);
+                if(found){
+                    EXPECT_FLOAT_EQ(best,hits[i].distance);
+                    EXPECT_FLOAT_EQ(best,single.distance);
+                }
+            }
+        }
+        struct CountingResource : std::pmr::memory_resource{
+            std::size_t allocations = 0;
+            std::size_t deallocations = 0;
+            void* do_allocate(std::size_t bytes, std::size_t alignment) override{
+                ++allocations;
+                return std::pmr::new_delete_resource()->allocate(bytes, alignment);
+            }
+            void do_deallocate(void* p, std::size_t bytes, std::size_t alignment) override{
+                ++deallocations;
+                std::pmr::new_delete_resource()->deallocate(p, bytes, alignment);
+            }
+            bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override{
+                return this == &other;
+            }
+        };
+        TEST(QuadtreeTest,Allocator){
+            using PmrQuadtree = Quadtree<Entity, std::pmr::polymorphic_allocator<Entity*>>;
+            CountingResource resource;
+            std::vector<Entity> entities;
+            entities.reserve(100);
+            {
+                PmrQuadtree qtree(Rectf(0,0,50,50), &resource);
+                qtree.setMaxCapacity(2);
+                qtree.setMaxLevel(4);
+                EXPECT_EQ(&resource, qtree.getAllocator().resource());
+                for(auto i=0u;i<100u;++i){
+                    entities.emplace_back(i,i % 50,(i * 7) % 50);
+                    qtree.insert(&entities.back());
+                }
+                EXPECT_TRUE(qtree.isSplit());
+                EXPECT_EQ(&resource, qtree[0].getAllocator().resource());
+                auto found = qtree.retrieve(&entities[0]);
+                EXPECT_EQ(&resource, found.get_allocator().resource());
+                EXPECT_FALSE(found.empty());
+                EXPECT_LT(0u, resource.allocations);
+            }
+            EXPECT_EQ(resource.allocations, resource.deallocations);
+        }
+        TEST(QuadtreeTest,Intersect){
+            Quadtree<Entity> dynamicTree(Rectf(0,0,50,50));
+            Quadtree<Entity> staticTree(Rectf(0,0,50,50));
+            dynamicTree.setMaxCapacity(2);
+            staticTree.setMaxCapacity(3);
+            std::mt19937 rEngine(7);
+            std::uniform_int_distribution<int> dice(0,49);
+            std::uniform_int_distribution<int> smallSize(0,4);
+            std::uniform_int_distribution<int> bigSize(0,8);
+            std::vector<Entity> dynamicEntities;
+            std::vector<Entity> staticEntities;
+            dynamicEntities.reserve(100);
+            staticEntities.reserve(150);
+            for(auto i=0u;i<100u;++i){
+                dynamicEntities.emplace_back(i,dice(rEngine),dice(rEngine));
+                dynamicEntities.back().b.width = smallSize(rEngine);
+                dynamicEntities.back().b.height = smallSize(rEngine);
+                dynamicTree.insert(&dynamicEntities.back());
+            }
+            for(auto i=0u;i<150u;++i){
+                staticEntities.emplace_back(i,dice(rEngine),dice(rEngine));
+                staticEntities.back().b.width = bigSize(rEngine);
+                staticEntities.back().b.height = bigSize(rEngine);
+                staticTree.insert(&staticEntities.back());
+            }
+            std::multiset<std::pair<int,int>> pairs;
+            dynamicTree.intersect(staticTree,[&](Entity* a, Entity* b){
+                pairs.emplace(a->id, b->id);
+            });
+            std::multiset<std::pair<int,int>> expected;
+            for(auto& a:dynamicEntities){
+                for(auto& b:staticEntities){
+                    if(a.b.left <= b.b.left + b.b.width && b.b.left <= a.b.left + a.b.width &&
+                        a.b.top <= b.b.top + b.b.height && b.b.top <= a.b.top + a.b.height){
+                        expected.emplace(a.id, b.id);
+                    }
+                }
+            }
+            EXPECT_FALSE(expected.empty());
+            EXPECT_EQ(expected,pairs);
+        }
+        TEST(QuadtreeTest,RetrieveWithFinger){
+            auto qtree = createQtree();
+            qtree->setMaxCapacity(2);
+            qtree->setMaxLevel(5);
+            std::mt19937 rEngine(11);
+            std::uniform_int_distribution<int> dice(0,49);
+            std::vector<Entity> entities;
+            entities.reserve(200);
+            for(auto i=0u;i<200u;++i){
+                entities.emplace_back(i,dice(rEngine),dice(rEngine));
+                qtree->insert(&entities.back());
+            }
+            Quadtree<Entity>::Finger finger;
+            Entity walker(-1,0,0);
+            for(auto step=0u;step<100u;++step){
+                walker.b.left = (step * 0.5f);
+                walker.b.top = (step * 0.3f);
+                EXPECT_EQ(qtree->retrieve(&walker),qtree->retrieve(&walker,finger));
+            }
+            for(auto& e:entities){
+                EXPECT_EQ(qtree->retrieve(&e),qtree->retrieve(&e,finger));
+            }
+            qtree->clear();
+            for(auto i=0u;i<100u;++i){
+                qtree->insert(&entities[i]);
+            }
+            for(auto& e:entities){
+                EXPECT_EQ(qtree->retrieve(&e),qtree->retrieve(&e,finger));
+            }
+            Quadtree<Entity> other(Rectf(0,0,50,50));
+            other.insert(&entities[0]);
+            auto found = other.retrieve(&entities[0],finger);
+            ASSERT_EQ(1u,found.size());
+            EXPECT_EQ(&entities[0],found[0]);
+        }
+        TEST(QuadtreeTest,RetrieveWithFingerRebuiltQuadtree){
+            std::vector<Entity> entities;
+            entities.reserve(50);
+            for(auto i=0u;i<50u;++i){
+                entities.emplace_back(i,i,(i * 7) % 50);
+            }
+            Quadtree<Entity>::Finger finger;
+            std::optional<Quadtree<Entity>> qtree;
+            const Quadtree<Entity>* address = nullptr;
+            for(auto frame=0u;frame<3u;++frame){
+                qtree.reset();
+                qtree.emplace(Rectf(0,0,50,50));
+                if(address != nullptr){
+                    ASSERT_EQ(address,&*qtree);
+                }
+                address = &*qtree;
+                qtree->setMaxCapacity(1).setMaxLevel(5);
+                for(auto& e:entities){
+                    qtree->insert(&e);
+                }
+                for(auto& e:entities){
+                    EXPECT_EQ(qtree->retrieve(&e),qtree->retrieve(&e,finger));
+                }
+            }
+        }
+        TEST(QuadtreeTest,RetrieveWithFingerInsertAndClear){
+            auto qtree = createQtree();
+            qtree->setMaxCapacity(1);
+            qtree->setMaxLevel(5);
+            std::vector<Entity> entities;
+            entities.reserve(100);
+            Quadtree<Entity>::Finger finger;
+            for(auto i=0u;i<50u;++i){
+                entities.emplace_back(i,10 + (i % 10) * 0.3f,10 + (i / 10) * 0.3f);
+                qtree->insert(&entities.back());
+                // the nodes on the path of the finger are split by the inserts.
+                EXPECT_EQ(qtree->retrieve(&entities[0]),qtree->retrieve(&entities[0],finger));
+                EXPECT_EQ(qtree->retrieve(&entities.back()),qtree->retrieve(&entities.back(),finger));
+            }
+            for(auto i=0u;i<50u;++i){
+                entities.emplace_back(50 + i,i,40);
+                qtree->insert(&entities.back());
+            }
+            ASSERT_TRUE(qtree->isSplit());
+            ASSERT_TRUE(qtree->getNode(0).isSplit());
+            EXPECT_EQ(qtree->retrieve(&entities[0]),qtree->retrieve(&entities[0],finger));
+            qtree->getNode(0).clear();
+            EXPECT_FALSE(qtree->getNode(0).isSplit());
+            for(auto& e:entities){
+                EXPECT_EQ(qtree->retrieve(&e),qtree->retrieve(&e,finger));
+            }
+            for(auto i=0u;i<50u;++i){
+                qtree->insert(&entities[i]);
+            }
+            EXPECT_EQ(qtree->retrieve(&entities[0]),qtree->retrieve(&entities[0],finger));
+        }
         TEST(QuadtreeTest,setBounds){
             auto qtree = createQtree();
             Rectf r(0,0,1000,1000);
@@ -41,6 +41,23 @@ namespace SPPAR{
 		EXPECT_FALSE(r1.intersects(noInter,result2));
 		EXPECT_EQ(result2,Rectf());
 	}
+	TEST(RectTest, intersectsRay){
+		Rectf r1(10,10,10,10);
+		float tNear, tFar;
+		EXPECT_TRUE(r1.intersects(Vector2f(0,15),Vector2f(1,0),tNear,tFar));
+		EXPECT_FLOAT_EQ(10,tNear);
+		EXPECT_FLOAT_EQ(20,tFar);
+		EXPECT_TRUE(r1.intersects(Vector2f(15,15),Vector2f(0,-1),tNear,tFar));
+		EXPECT_FLOAT_EQ(0,tNear);
+		EXPECT_FLOAT_EQ(5,tFar);
+		EXPECT_TRUE(r1.intersects(Vector2f(0,0),Vector2f(1,1),tNear,tFar));
+		EXPECT_FLOAT_EQ(10,tNear);
+		EXPECT_FALSE(r1.intersects(Vector2f(0,15),Vector2f(-1,0),tNear,tFar));
+		EXPECT_FALSE(r1.intersects(Vector2f(0,25),Vector2f(1,0),tNear,tFar));
+		Rectf point(5,5,0,0);
+		EXPECT_TRUE(point.intersects(Vector2f(0,5),Vector2f(1,0),tNear,tFar));
+		EXPECT_FLOAT_EQ(5,tNear);
+	}
     }
 }
 
@@ -1,6 +1,7 @@
 #include <iostream>
 #include <gtest/gtest.h>
 #include "Quadtree/QuadtreeTest.hpp"
+#include "CompactQuadtree/CompactQuadtreeTest.hpp"
 #include "Rect/RectTest.hpp"
 
 int main(int argc, char** argv){